@@ -6,6 +6,11 @@ APP_DIR=$(dirname "$(readlink -f "$0")")
 BUILD_DIR="$APP_DIR/build"
 OVERLAY_CONFIG=overlay-OT-0x2410-mtd.conf
 
+# ./build-xiao.sh dict -> dictionary (binary) logging, decoderen met ./decode-log.sh
+if [ "$1" == "dict" ]; then
+    OVERLAY_CONFIG="$OVERLAY_CONFIG;overlay-log-dictionary.conf"
+fi
+
 echo "-----------------------------------"
 echo "Building project for board $BOARD..."
 echo "-----------------------------------"
@@ -17,7 +22,7 @@ if [ -d "$BUILD_DIR" ]; then
 fi
 
 # Start de build
-west build -b $BOARD --pristine=always -- -DOVERLAY_CONFIG=$OVERLAY_CONFIG
+west build -b $BOARD --pristine=always -- -DOVERLAY_CONFIG="$OVERLAY_CONFIG"
 
 if [ $? -ne 0 ]; then
     echo
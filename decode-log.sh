@@ -0,0 +1,26 @@
+#!/bin/bash
+set -e
+
+APP_DIR=$(dirname "$(readlink -f "$0")")
+LOG_DB="$APP_DIR/build/zephyr/log_dictionary.json"
+PORT=${1:-$(ls /dev/cu.usbmodem* 2>/dev/null | head -n 1)}
+BAUD=${2:-115200}
+
+# Decodeert dictionary logging (build met: ./build-xiao.sh dict)
+if [ ! -f "$LOG_DB" ]; then
+    echo "❌ Log database niet gevonden op $LOG_DB"
+    exit 1
+fi
+
+if [ -z "$PORT" ]; then
+    echo "❌ Geen seriële poort gevonden. Gebruik: $0 <poort> [baudrate]"
+    exit 1
+fi
+
+if [ -z "$ZEPHYR_BASE" ]; then
+    echo "❌ ZEPHYR_BASE is niet gezet"
+    exit 1
+fi
+
+echo "📥 Logs decoderen van $PORT ($BAUD baud)..."
+python3 "$ZEPHYR_BASE/scripts/logging/dictionary/log_parser_uart.py" "$LOG_DB" "$PORT" "$BAUD"
@@ -0,0 +1,184 @@
+#include "cmd_utils.h"
+#include <zephyr/logging/log.h>
+#include <zephyr/sys/atomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "log_utils.h"
+
+LOG_MODULE_REGISTER(cmd_utils, LOG_LEVEL_INF);
+
+static atomic_t read_requested;
+static uint32_t interval_ms;
+static enum cmd_report_policy policy = CMD_REPORT_ALWAYS;
+static float report_delta;
+static bool resolution_supported;
+static atomic_t resolution_changed;
+static bool resolution_low;
+static atomic_t console_changed;
+static bool console_on;
+
+static float last_value[CMD_UTILS_MAX_CHANNELS];
+static bool last_valid[CMD_UTILS_MAX_CHANNELS];
+
+void cmd_utils_init(uint32_t poll_interval_ms)
+{
+    interval_ms = poll_interval_ms;
+    atomic_clear(&read_requested);
+    atomic_clear(&resolution_changed);
+    atomic_clear(&console_changed);
+    memset(last_valid, 0, sizeof(last_valid));
+}
+
+void cmd_utils_enable_resolution(bool enable)
+{
+    resolution_supported = enable;
+}
+
+static int parse_interval(const char *arg)
+{
+    char *end;
+    unsigned long secs = strtoul(arg, &end, 10);
+
+    if (end == arg || *end != '\0') {
+        return -EINVAL;
+    }
+    if (secs < CMD_UTILS_MIN_INTERVAL_MS / 1000U || secs > CMD_UTILS_MAX_INTERVAL_MS / 1000U) {
+        return -ERANGE;
+    }
+
+    interval_ms = secs * 1000U;
+    LOG_INF("Poll interval set to %lus", secs);
+    return 0;
+}
+
+static int parse_report(const char *arg)
+{
+    if (strcmp(arg, "always") == 0) {
+        policy = CMD_REPORT_ALWAYS;
+        LOG_INF("Report policy: always");
+        return 0;
+    }
+
+    if (strncmp(arg, "change ", 7) == 0) {
+        char *end;
+        float delta = strtof(arg + 7, &end);
+        if (end == arg + 7 || *end != '\0' || delta <= 0.0f) {
+            return -EINVAL;
+        }
+        policy = CMD_REPORT_ON_CHANGE;
+        report_delta = delta;
+        // Logging has no float support (no CONFIG_CBPRINTF_FP_SUPPORT)
+        char delta_str[16];
+        snprintf(delta_str, sizeof(delta_str), "%.2f", (double)delta);
+        LOG_INF("Report policy: on change >= %s", delta_str);
+        return 0;
+    }
+
+    return -EINVAL;
+}
+
+static int parse_resolution(const char *arg)
+{
+    if (!resolution_supported) {
+        return -ENOTSUP;
+    }
+
+    if (strcmp(arg, "low") == 0) {
+        resolution_low = true;
+    } else if (strcmp(arg, "high") == 0) {
+        resolution_low = false;
+    } else {
+        return -EINVAL;
+    }
+
+    // Applied and logged by the sensor owner, see cmd_utils_take_resolution_change()
+    atomic_set(&resolution_changed, 1);
+    return 0;
+}
+
+static int parse_console(const char *arg)
+{
+    if (strcmp(arg, "on") == 0) {
+        console_on = true;
+    } else if (strcmp(arg, "off") == 0) {
+        console_on = false;
+    } else {
+        return -EINVAL;
+    }
+
+    atomic_set(&console_changed, 1);
+    return 0;
+}
+
+void cmd_utils_handle(const char *topic, const char *payload, size_t len)
+{
+    int rc;
+
+    ARG_UNUSED(topic);
+    ARG_UNUSED(len);
+
+    if (strcmp(payload, "read") == 0) {
+        atomic_set(&read_requested, 1);
+        rc = 0;
+    } else if (strncmp(payload, "interval ", 9) == 0) {
+        rc = parse_interval(payload + 9);
+    } else if (strncmp(payload, "report ", 7) == 0) {
+        rc = parse_report(payload + 7);
+    } else if (strncmp(payload, "resolution ", 11) == 0) {
+        rc = parse_resolution(payload + 11);
+    } else if (strncmp(payload, "console ", 8) == 0) {
+        rc = parse_console(payload + 8);
+    } else {
+        rc = -ENOTSUP;
+    }
+
+    if (rc != 0) {
+        LOG_UTILS_WRN_RATELIMIT("Rejected command '%s': %d", payload, rc);
+    }
+}
+
+bool cmd_utils_take_read_request(void)
+{
+    return atomic_cas(&read_requested, 1, 0);
+}
+
+uint32_t cmd_utils_get_interval_ms(void)
+{
+    return interval_ms;
+}
+
+bool cmd_utils_take_resolution_change(bool *low_res)
+{
+    if (!atomic_cas(&resolution_changed, 1, 0)) {
+        return false;
+    }
+    *low_res = resolution_low;
+    return true;
+}
+
+bool cmd_utils_take_console_request(bool *on)
+{
+    if (!atomic_cas(&console_changed, 1, 0)) {
+        return false;
+    }
+    *on = console_on;
+    return true;
+}
+
+bool cmd_utils_should_report(int channel, float value, bool force)
+{
+    if (channel < 0 || channel >= CMD_UTILS_MAX_CHANNELS) {
+        return true;
+    }
+
+    if (!force && policy == CMD_REPORT_ON_CHANGE && last_valid[channel] &&
+        fabsf(value - last_value[channel]) < report_delta) {
+        return false;
+    }
+
+    last_value[channel] = value;
+    last_valid[channel] = true;
+    return true;
+}
@@ -0,0 +1,37 @@
+#ifndef CMD_UTILS_H
+#define CMD_UTILS_H
+
+#include <zephyr/kernel.h>
+#include <stdbool.h>
+
+#define CMD_UTILS_MAX_CHANNELS      16
+#define CMD_UTILS_MIN_INTERVAL_MS   10000     // 10s
+#define CMD_UTILS_MAX_INTERVAL_MS   86400000  // 24h
+
+/*
+ * Commands (plain text payload on NODE_ID "-in/cmd"):
+ *   read                 - acquire and publish now, outside the schedule
+ *   interval <seconds>   - change the poll interval
+ *   report always        - publish every reading
+ *   report change <delta> - only publish readings that moved by >= delta
+ *   resolution low|high  - fast low-resolution or full-resolution measurements
+ *                          (only when enabled, i.e. an SHT75 is fitted)
+ *   console on|off       - keep the console awake between cycles (otherwise logs
+ *                          are held until the next wake-up)
+ */
+
+enum cmd_report_policy {
+    CMD_REPORT_ALWAYS,
+    CMD_REPORT_ON_CHANGE,
+};
+
+void cmd_utils_init(uint32_t poll_interval_ms);
+void cmd_utils_enable_resolution(bool enable);
+void cmd_utils_handle(const char *topic, const char *payload, size_t len);
+bool cmd_utils_take_read_request(void);
+uint32_t cmd_utils_get_interval_ms(void);
+bool cmd_utils_take_resolution_change(bool *low_res);
+bool cmd_utils_take_console_request(bool *on);
+bool cmd_utils_should_report(int channel, float value, bool force);
+
+#endif /* CMD_UTILS_H */
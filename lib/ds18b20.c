@@ -1,11 +1,16 @@
 #include "ds18b20.h"
 #include <zephyr/kernel.h>
 #include <zephyr/logging/log.h>
+#include <string.h>
+#include "log_utils.h"
 
 LOG_MODULE_REGISTER(ds18b20, LOG_LEVEL_INF);
 
 #define SLOT_TIME_US 65
 
+// Assume parasite power until Read Power Supply proves otherwise
+static bool parasite_power = true;
+
 #define BUS_LOW(cfg)  gpio_pin_set_dt(&(struct gpio_dt_spec){.port = cfg->gpio_dev, .pin = cfg->data_pin}, 0)
 #define BUS_HIGH(cfg) gpio_pin_set_dt(&(struct gpio_dt_spec){.port = cfg->gpio_dev, .pin = cfg->data_pin}, 1)
 #define BUS_READ(cfg) gpio_pin_get_dt(&(struct gpio_dt_spec){.port = cfg->gpio_dev, .pin = cfg->data_pin})
@@ -73,72 +78,229 @@ static uint8_t read_byte(const struct ds18b20_config *cfg)
     return value;
 }
 
-int ds18b20_scan(const struct ds18b20_config *cfg, struct ds18b20_rom *roms, int max)
+// Dallas/Maxim CRC8 (x^8 + x^5 + x^4 + 1), LSB first
+static uint8_t crc8(const uint8_t *data, int len)
 {
-    int found = 0;
+    uint8_t crc = 0;
+    for (int i = 0; i < len; i++) {
+        uint8_t byte = data[i];
+        for (int j = 0; j < 8; j++) {
+            uint8_t mix = (crc ^ byte) & 0x01;
+            crc >>= 1;
+            if (mix) crc ^= 0x8C;
+            byte >>= 1;
+        }
+    }
+    return crc;
+}
 
-    if (onewire_reset(cfg) != 0)
-        return 0;
+static bool rom_valid(const uint8_t *rom)
+{
+    bool all_zero = true;
+    for (int i = 0; i < 8; i++) {
+        all_zero &= (rom[i] == 0x00);
+    }
 
-    write_byte(cfg, 0xF0); // Search ROM
+    return !all_zero && rom[0] == DS18B20_FAMILY_CODE && crc8(rom, 7) == rom[7];
+}
 
+static void select_rom(const struct ds18b20_config *cfg, const struct ds18b20_rom *rom)
+{
+    write_byte(cfg, 0x55); // Match ROM
+    for (int i = 0; i < 8; i++) {
+        write_byte(cfg, rom->rom[i]);
+    }
+}
+
+/*
+ * Binary tree walk shared by Search ROM (0xF0) and Alarm Search (0xEC).
+ * Each pass follows the previous path up to the last unexplored 0-branch
+ * and takes the 1-branch there, so every device is visited exactly once.
+ */
+static int onewire_search(const struct ds18b20_config *cfg, uint8_t cmd,
+                          struct ds18b20_rom *roms, int max)
+{
     uint8_t rom[8] = {0};
-    for (int bit = 0; bit < 64 && found < max; bit++) {
-        int b = read_bit(cfg);
-        int nb = read_bit(cfg);
-
-        if (b == 1 && nb == 1)
-            break; // No devices
-
-        int bit_choice = 0;
-        if (b == 0 && nb == 0) {
-            bit_choice = 0; // Choose zero path
-        } else {
-            bit_choice = b;
+    int last_discrepancy = -1;
+    int found = 0;
+
+    while (found < max) {
+        int last_zero = -1;
+
+        if (onewire_reset(cfg) != 0)
+            break;
+
+        write_byte(cfg, cmd);
+
+        for (int bit = 0; bit < 64; bit++) {
+            int b = read_bit(cfg);
+            int nb = read_bit(cfg);
+            int dir;
+
+            if (b == 1 && nb == 1)
+                return found; // No (more) devices respond
+
+            if (b != nb) {
+                dir = b;
+            } else if (bit < last_discrepancy) {
+                dir = (rom[bit / 8] >> (bit % 8)) & 0x01;
+            } else {
+                dir = (bit == last_discrepancy);
+            }
+
+            if (b == 0 && nb == 0 && dir == 0)
+                last_zero = bit;
+
+            if (dir)
+                rom[bit / 8] |= (1 << (bit % 8));
+            else
+                rom[bit / 8] &= ~(1 << (bit % 8));
+
+            write_bit(cfg, dir);
         }
 
-        write_bit(cfg, bit_choice);
-        rom[bit / 8] |= (bit_choice << (bit % 8));
+        /*
+         * A corrupt ROM means the walk itself is unreliable (e.g. a bus stuck
+         * low reads 0/0 on every bit and yields an all-zero ROM that passes
+         * the CRC), so stop instead of counting through phantom devices.
+         */
+        if (!rom_valid(rom)) {
+            LOG_WRN("Invalid ROM during search, stopping after %d device(s)", found);
+            return found;
+        }
+
+        memcpy(roms[found].rom, rom, 8);
+        found++;
+
+        last_discrepancy = last_zero;
+        if (last_discrepancy < 0)
+            break; // Whole tree walked
     }
 
-    memcpy(roms[found].rom, rom, 8);
-    return ++found;
+    return found;
 }
 
-int ds18b20_read_temp(const struct ds18b20_config *cfg, const struct ds18b20_rom *rom, float *temp_c)
+static int read_power_supply(const struct ds18b20_config *cfg)
 {
     if (onewire_reset(cfg) != 0)
-        return -1;
+        return -ENODEV;
 
     write_byte(cfg, 0xCC); // Skip ROM
+    write_byte(cfg, 0xB4); // Read Power Supply
+    parasite_power = !read_bit(cfg); // Parasite-powered devices pull the slot low
+    return 0;
+}
+
+int ds18b20_scan(const struct ds18b20_config *cfg, struct ds18b20_rom *roms, int max)
+{
+    int found = onewire_search(cfg, 0xF0, roms, max); // Search ROM
 
+    if (found > 0 && read_power_supply(cfg) == 0) {
+        LOG_INF("Bus power: %s", parasite_power ? "parasite" : "external");
+    }
+    return found;
+}
 
-    write_byte(cfg, 0x44); // Convert T
-    k_sleep(K_MSEC(750));
+int ds18b20_alarm_search(const struct ds18b20_config *cfg, struct ds18b20_rom *roms, int max)
+{
+    return onewire_search(cfg, 0xEC, roms, max); // Alarm Search
+}
 
+int ds18b20_set_alarm(const struct ds18b20_config *cfg, const struct ds18b20_rom *rom,
+                      int8_t tl, int8_t th)
+{
     if (onewire_reset(cfg) != 0)
-        return -2;
+        return -1;
+
+    select_rom(cfg, rom);
+    write_byte(cfg, 0x4E); // Write Scratchpad
+    write_byte(cfg, (uint8_t)th);
+    write_byte(cfg, (uint8_t)tl);
+    write_byte(cfg, DS18B20_CFG_12BIT);
+    return 0;
+}
+
+/*
+ * Externally powered devices hold read slots low while converting, so stop
+ * waiting as soon as all are done. Parasite-powered devices need the bus
+ * driven high (strong pull-up) for the full conversion time instead.
+ */
+static void wait_conversion(const struct ds18b20_config *cfg)
+{
+    if (parasite_power) {
+        BUS_OUT(cfg);
+        BUS_HIGH(cfg);
+        k_sleep(K_MSEC(DS18B20_CONVERT_MS));
+        return;
+    }
+
+    for (int waited = 0; waited < DS18B20_CONVERT_MS; waited += DS18B20_CONVERT_POLL_MS) {
+        k_sleep(K_MSEC(DS18B20_CONVERT_POLL_MS));
+        if (read_bit(cfg))
+            return;
+    }
+}
+
+int ds18b20_convert_all(const struct ds18b20_config *cfg)
+{
+    if (onewire_reset(cfg) != 0)
+        return -ENODEV;
 
     write_byte(cfg, 0xCC); // Skip ROM
+    write_byte(cfg, 0x44); // Convert T
+    wait_conversion(cfg);
+    return 0;
+}
 
+int ds18b20_read_result(const struct ds18b20_config *cfg, const struct ds18b20_rom *rom, float *temp_c)
+{
+    if (onewire_reset(cfg) != 0)
+        return -ENODEV;
 
+    select_rom(cfg, rom);
     write_byte(cfg, 0xBE); // Read Scratchpad
 
     uint8_t scratchpad[9];
-	for (int i = 0; i < 9; i++) {
-    	scratchpad[i] = read_byte(cfg);
-    	printk("scratchpad[%d] = 0x%02X\n", i, scratchpad[i]);
-	}
+    for (int i = 0; i < 9; i++) {
+        scratchpad[i] = read_byte(cfg);
+    }
+    LOG_UTILS_HOT_HEXDUMP(scratchpad, sizeof(scratchpad), "scratchpad");
+
+    bool all_ones = true, all_zero = true;
+    for (int i = 0; i < 9; i++) {
+        all_ones &= (scratchpad[i] == 0xFF);
+        all_zero &= (scratchpad[i] == 0x00);
+    }
+    if (all_ones)
+        return -ENODEV; // Nobody answered the Match ROM
+    if (all_zero)
+        return -EIO;    // Bus stuck low, passes the CRC
+    if (crc8(scratchpad, 8) != scratchpad[8])
+        return -EBADMSG;
 
 	uint8_t lsb = scratchpad[0];
 	uint8_t msb = scratchpad[1];
 
     int16_t raw = (msb << 8) | lsb;
+    if (raw == DS18B20_POWER_ON_RAW)
+        return -EAGAIN; // 85 C power-on value, no conversion took place
 
     *temp_c = raw * 0.0625f;
     return 0;
 }
 
+int ds18b20_read_temp(const struct ds18b20_config *cfg, const struct ds18b20_rom *rom, float *temp_c)
+{
+    if (onewire_reset(cfg) != 0)
+        return -ENODEV;
+
+    select_rom(cfg, rom);
+    write_byte(cfg, 0x44); // Convert T
+    wait_conversion(cfg);
+
+    return ds18b20_read_result(cfg, rom, temp_c);
+}
+
 int ds18b20_init(const struct ds18b20_config *cfg)
 {
     if (!device_is_ready(cfg->gpio_dev))
@@ -148,3 +310,18 @@ int ds18b20_init(const struct ds18b20_config *cfg)
     BUS_HIGH(cfg);
     return 0;
 }
+
+// Disconnect the pin between cycles, the external pull-up keeps the bus idle high
+int ds18b20_suspend(const struct ds18b20_config *cfg)
+{
+    return gpio_pin_configure_dt(&(struct gpio_dt_spec){.port = cfg->gpio_dev, .pin = cfg->data_pin}, GPIO_DISCONNECTED);
+}
+
+int ds18b20_resume(const struct ds18b20_config *cfg)
+{
+    int ret = BUS_OUT(cfg);
+    if (ret < 0)
+        return ret;
+
+    return BUS_HIGH(cfg);
+}
@@ -5,6 +5,11 @@
 #include <zephyr/drivers/gpio.h>
 
 #define DS18B20_MAX_SENSORS 10
+#define DS18B20_FAMILY_CODE 0x28
+#define DS18B20_CONVERT_MS  750  // 12-bit conversion time
+#define DS18B20_CONVERT_POLL_MS 10
+#define DS18B20_POWER_ON_RAW 0x0550 // 85 C reset value of the scratchpad
+#define DS18B20_CFG_12BIT   0x7F
 
 struct ds18b20_rom {
     uint8_t rom[8];
@@ -16,7 +21,24 @@ struct ds18b20_config {
 };
 
 int ds18b20_init(const struct ds18b20_config *cfg);
+int ds18b20_suspend(const struct ds18b20_config *cfg);
+int ds18b20_resume(const struct ds18b20_config *cfg);
 int ds18b20_scan(const struct ds18b20_config *cfg, struct ds18b20_rom *roms, int max);
 int ds18b20_read_temp(const struct ds18b20_config *cfg, const struct ds18b20_rom *rom, float *temp_c);
 
+/*
+ * Alarm mode: program a TL/TH window (whole degrees) per sensor, start one
+ * broadcast conversion, then use ds18b20_alarm_search() to find the sensors
+ * that measured T <= TL or T >= TH and read only those.
+ */
+int ds18b20_set_alarm(const struct ds18b20_config *cfg, const struct ds18b20_rom *rom,
+                      int8_t tl, int8_t th);
+int ds18b20_convert_all(const struct ds18b20_config *cfg);
+int ds18b20_alarm_search(const struct ds18b20_config *cfg, struct ds18b20_rom *roms, int max);
+/*
+ * Returns -ENODEV (no presence / no answer), -EIO (bus stuck low),
+ * -EBADMSG (scratchpad CRC) or -EAGAIN (85 C power-on value).
+ */
+int ds18b20_read_result(const struct ds18b20_config *cfg, const struct ds18b20_rom *rom, float *temp_c);
+
 #endif // DS18B20_H
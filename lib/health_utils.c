@@ -0,0 +1,71 @@
+#include "health_utils.h"
+#include <zephyr/logging/log.h>
+#include <stdio.h>
+#include <string.h>
+
+LOG_MODULE_REGISTER(health_utils, LOG_LEVEL_INF);
+
+static const char *const status_names[] = {
+    [HEALTH_OK] = "ok",
+    [HEALTH_DEGRADED] = "degraded",
+    [HEALTH_QUARANTINED] = "quarantined",
+};
+
+void health_utils_init(struct health_state *h, const char *label)
+{
+    memset(h, 0, sizeof(*h));
+    snprintf(h->label, sizeof(h->label), "%s", label);
+    h->status = HEALTH_OK;
+}
+
+bool health_utils_available(const struct health_state *h)
+{
+    return h->status != HEALTH_QUARANTINED || k_uptime_get() >= h->quarantine_until;
+}
+
+/* Returns true when the status changed */
+bool health_utils_report(struct health_state *h, int err)
+{
+    enum health_status prev = h->status;
+
+    if (err == 0) {
+        h->consecutive_failures = 0;
+        h->backoff_ms = 0;
+        h->status = HEALTH_OK;
+        return h->status != prev;
+    }
+
+    h->last_error = err;
+    h->total_failures++;
+    if (h->consecutive_failures < UINT16_MAX) {
+        h->consecutive_failures++;
+    }
+
+    if (h->consecutive_failures < HEALTH_UTILS_QUARANTINE_AFTER) {
+        h->status = HEALTH_DEGRADED;
+        return h->status != prev;
+    }
+
+    // Exponential backoff, a failed probe after quarantine doubles it
+    if (h->backoff_ms == 0) {
+        h->backoff_ms = HEALTH_UTILS_BACKOFF_MIN_MS;
+    } else if (h->backoff_ms < HEALTH_UTILS_BACKOFF_MAX_MS / 2) {
+        h->backoff_ms *= 2;
+    } else {
+        h->backoff_ms = HEALTH_UTILS_BACKOFF_MAX_MS;
+    }
+    h->quarantine_until = k_uptime_get() + h->backoff_ms;
+    h->status = HEALTH_QUARANTINED;
+    LOG_WRN("%s quarantined for %us after %u failures (last %d)",
+            h->label, h->backoff_ms / 1000U, h->consecutive_failures, err);
+    return h->status != prev;
+}
+
+int health_utils_format(const struct health_state *h, char *buf, size_t len)
+{
+    if (h->status == HEALTH_OK) {
+        return snprintf(buf, len, "%s", status_names[h->status]);
+    }
+    return snprintf(buf, len, "%s,%u,%d", status_names[h->status],
+                    h->consecutive_failures, h->last_error);
+}
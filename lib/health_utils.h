@@ -0,0 +1,33 @@
+#ifndef HEALTH_UTILS_H
+#define HEALTH_UTILS_H
+
+#include <zephyr/kernel.h>
+#include <stdbool.h>
+
+#define HEALTH_UTILS_MAX_RETRIES      2         // Extra attempts per read
+#define HEALTH_UTILS_QUARANTINE_AFTER 3         // Consecutive failed cycles
+#define HEALTH_UTILS_BACKOFF_MIN_MS   600000    // 10 min
+#define HEALTH_UTILS_BACKOFF_MAX_MS   86400000  // 24h
+
+enum health_status {
+    HEALTH_OK,
+    HEALTH_DEGRADED,    // Failing, still read every cycle
+    HEALTH_QUARANTINED, // Skipped until the backoff expires
+};
+
+struct health_state {
+    char label[16];     // Sensor name for log messages
+    enum health_status status;
+    uint16_t consecutive_failures;
+    uint32_t total_failures;
+    uint32_t backoff_ms;
+    int64_t quarantine_until;
+    int last_error;
+};
+
+void health_utils_init(struct health_state *h, const char *label);
+bool health_utils_available(const struct health_state *h);
+bool health_utils_report(struct health_state *h, int err);
+int health_utils_format(const struct health_state *h, char *buf, size_t len);
+
+#endif /* HEALTH_UTILS_H */
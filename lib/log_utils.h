@@ -0,0 +1,46 @@
+#ifndef LOG_UTILS_H
+#define LOG_UTILS_H
+
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+
+/*
+ * Hot-path traces (bus timing, per-message network logging) are compiled
+ * out unless the build sets LOG_UTILS_HOT_PATH=1 (cmake -DLOG_HOT_PATH=ON).
+ */
+#ifndef LOG_UTILS_HOT_PATH
+#define LOG_UTILS_HOT_PATH 0
+#endif
+
+#if LOG_UTILS_HOT_PATH
+#define LOG_UTILS_HOT(...)                         LOG_INF(__VA_ARGS__)
+#define LOG_UTILS_HOT_HEXDUMP(data, len, str)      LOG_HEXDUMP_INF(data, len, str)
+#else
+#define LOG_UTILS_HOT(...)                         do { } while (0)
+#define LOG_UTILS_HOT_HEXDUMP(data, len, str)      do { } while (0)
+#endif
+
+/*
+ * Rate limiting per call site. A module can define LOG_UTILS_RATELIMIT_MS
+ * before including this header to pick its own interval.
+ */
+#ifndef LOG_UTILS_RATELIMIT_MS
+#define LOG_UTILS_RATELIMIT_MS 10000
+#endif
+
+#define LOG_UTILS_RATELIMIT(_log, ...)                                  \
+    do {                                                                \
+        static int64_t _rl_last;                                        \
+        static bool _rl_seen;                                           \
+        int64_t _rl_now = k_uptime_get();                               \
+        if (!_rl_seen || _rl_now - _rl_last >= LOG_UTILS_RATELIMIT_MS) { \
+            _rl_seen = true;                                            \
+            _rl_last = _rl_now;                                         \
+            _log(__VA_ARGS__);                                          \
+        }                                                               \
+    } while (0)
+
+#define LOG_UTILS_ERR_RATELIMIT(...) LOG_UTILS_RATELIMIT(LOG_ERR, __VA_ARGS__)
+#define LOG_UTILS_WRN_RATELIMIT(...) LOG_UTILS_RATELIMIT(LOG_WRN, __VA_ARGS__)
+
+#endif /* LOG_UTILS_H */
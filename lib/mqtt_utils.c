@@ -4,12 +4,16 @@
 #include <zephyr/logging/log.h>
 #include <string.h>
 #include <zephyr/kernel.h>
+#include "log_utils.h"
 
 LOG_MODULE_REGISTER(mqtt_utils, LOG_LEVEL_INF);
 
 static struct sockaddr_in6 broker;
 static uint8_t rx_buffer[256], tx_buffer[256];
 static struct mqtt_utf8 client_id, username, password;
+static mqtt_utils_msg_handler_t msg_handler;
+static int connack_result;
+static uint16_t last_message_id;
 
 void mqtt_utils_set_credentials(const char *id, const char *user, const char *pass)
 {
@@ -21,6 +25,98 @@ void mqtt_utils_set_credentials(const char *id, const char *user, const char *pa
     password.size = strlen(pass);
 }
 
+void mqtt_utils_set_msg_handler(mqtt_utils_msg_handler_t handler)
+{
+    msg_handler = handler;
+}
+
+static void handle_publish(struct mqtt_client *c, const struct mqtt_publish_param *p)
+{
+    char topic[MQTT_UTILS_TOPIC_MAX_LEN];
+    char payload[MQTT_UTILS_PAYLOAD_MAX_LEN];
+    size_t remaining = p->message.payload.len;
+    size_t len = MIN(remaining, sizeof(payload) - 1);
+    size_t topic_len = MIN(p->message.topic.topic.size, sizeof(topic) - 1);
+    int rc;
+
+    // Topic in rx_buffer is not NUL-terminated
+    memcpy(topic, p->message.topic.topic.utf8, topic_len);
+    topic[topic_len] = '\0';
+
+    rc = mqtt_readall_publish_payload(c, (uint8_t *)payload, len);
+    if (rc != 0) {
+        LOG_ERR("Payload read failed: %d", rc);
+        return;
+    }
+    payload[len] = '\0';
+    remaining -= len;
+
+    // Drain oversized payloads so the stream stays in sync
+    while (remaining > 0) {
+        size_t chunk = MIN(remaining, sizeof(payload));
+        rc = mqtt_readall_publish_payload(c, (uint8_t *)payload, chunk);
+        if (rc != 0) {
+            LOG_ERR("Payload drain failed: %d", rc);
+            return;
+        }
+        remaining -= chunk;
+        len = 0;
+    }
+
+    if (p->message.topic.qos == MQTT_QOS_1_AT_LEAST_ONCE) {
+        const struct mqtt_puback_param ack = { .message_id = p->message_id };
+        mqtt_publish_qos1_ack(c, &ack);
+    }
+
+    if (len == 0) {
+        LOG_WRN("Dropped empty or oversized message on %s", topic);
+        return;
+    }
+
+    LOG_INF("Received: %s = %s", topic, payload);
+    if (msg_handler) {
+        msg_handler(topic, payload, len);
+    }
+}
+
+static void mqtt_evt_handler(struct mqtt_client *c, const struct mqtt_evt *evt)
+{
+    switch (evt->type) {
+    case MQTT_EVT_CONNACK:
+        connack_result = evt->result;
+        if (evt->result != 0) {
+            LOG_ERR("Connection refused: %d", evt->result);
+        }
+        break;
+    case MQTT_EVT_DISCONNECT:
+        LOG_INF("Broker disconnected: %d", evt->result);
+        break;
+    case MQTT_EVT_SUBACK:
+        LOG_INF("Subscribed (id %u)", evt->param.suback.message_id);
+        break;
+    case MQTT_EVT_PUBLISH:
+        handle_publish(c, &evt->param.publish);
+        break;
+    case MQTT_EVT_PUBACK:
+        LOG_DBG("Publish acked (id %u)", evt->param.puback.message_id);
+        break;
+    case MQTT_EVT_PINGRESP:
+        LOG_DBG("Ping response");
+        break;
+    default:
+        break;
+    }
+}
+
+// MQTT packet identifiers are 16 bit and must not be 0
+static uint16_t next_message_id(void)
+{
+    if (++last_message_id == 0) {
+        last_message_id = 1;
+    }
+    return last_message_id;
+}
+
 static void setup_socket(struct mqtt_client *c)
 {
     if (c->transport.tcp.sock >= 0) {
@@ -59,6 +155,7 @@ int mqtt_utils_connect(struct mqtt_client *client)
     client->tx_buf = tx_buffer;
     client->tx_buf_size = sizeof(tx_buffer);
     client->transport.type = MQTT_TRANSPORT_NON_SECURE;
+    client->evt_cb = mqtt_evt_handler;
 
     setup_socket(client);
     if (client->transport.tcp.sock < 0) {
@@ -66,6 +163,7 @@ int mqtt_utils_connect(struct mqtt_client *client)
     }
 
     LOG_INF("Connecting to broker...");
+    connack_result = -ETIMEDOUT; // Overwritten by the CONNACK event
     rc = mqtt_connect(client);
     if (rc != 0) {
         LOG_ERR("Connect failed: %d", rc);
@@ -90,6 +188,11 @@ int mqtt_utils_connect(struct mqtt_client *client)
         return rc;
     }
 
+    if (connack_result != 0) {
+        mqtt_abort(client);
+        return connack_result > 0 ? -ECONNREFUSED : connack_result;
+    }
+
     LOG_INF("Connected to broker!");
     return 0;
 }
@@ -103,35 +206,82 @@ int mqtt_utils_publish(struct mqtt_client *client, const char *topic, const char
     param.message.topic.topic.size = strlen(topic);
     param.message.payload.data = (uint8_t *)payload;
     param.message.payload.len = strlen(payload);
-    param.message_id = k_uptime_get_32();
+    param.message_id = next_message_id();
     param.dup_flag = 0U;
     param.retain_flag = 0U;
 
-    LOG_INF("Sending: %s = %s", topic, payload);
+    LOG_UTILS_HOT("Sending: %s = %s", topic, payload);
     int rc = mqtt_publish(client, &param);
     if (rc != 0) {
-        LOG_ERR("Send failed: %d", rc);
+        LOG_UTILS_ERR_RATELIMIT("Send failed: %d", rc);
+    }
+    return rc;
+}
+
+int mqtt_utils_subscribe(struct mqtt_client *client, const char *topic)
+{
+    struct mqtt_topic sub_topic = {
+        .topic = {
+            .utf8 = (uint8_t *)topic,
+            .size = strlen(topic)
+        },
+        .qos = MQTT_QOS_1_AT_LEAST_ONCE
+    };
+    const struct mqtt_subscription_list list = {
+        .list = &sub_topic,
+        .list_count = 1,
+        .message_id = next_message_id()
+    };
+
+    LOG_INF("Subscribing to %s", topic);
+    int rc = mqtt_subscribe(client, &list);
+    if (rc != 0) {
+        LOG_ERR("Subscribe failed: %d", rc);
     }
     return rc;
 }
 
-int mqtt_utils_keepalive(struct mqtt_client *client)
+int mqtt_utils_process(struct mqtt_client *client, int32_t timeout_ms)
 {
+    struct zsock_pollfd fds[1];
+    int rc;
+
     if (client->transport.tcp.sock < 0) {
         LOG_ERR("Not connected");
         return -ENOTCONN;
     }
 
-    LOG_INF("Pinging broker...");
-    int rc = mqtt_ping(client);
-    if (rc != 0) {
-        LOG_ERR("Ping failed: %d", rc);
-        return rc;
+    // Never sleep past the moment a PINGREQ is due
+    int keepalive_ms = mqtt_keepalive_time(client);
+    if (keepalive_ms >= 0 && keepalive_ms < timeout_ms) {
+        timeout_ms = keepalive_ms;
     }
 
-    rc = mqtt_input(client);
-    if (rc != 0) {
-        LOG_ERR("Input failed: %d", rc);
+    fds[0].fd = client->transport.tcp.sock;
+    fds[0].events = ZSOCK_POLLIN;
+    rc = zsock_poll(fds, 1, timeout_ms);
+    if (rc < 0) {
+        LOG_ERR("Poll failed: %d", errno);
+        return -errno;
+    }
+
+    if (rc > 0) {
+        if (fds[0].revents & (ZSOCK_POLLERR | ZSOCK_POLLHUP | ZSOCK_POLLNVAL)) {
+            LOG_ERR("Connection lost");
+            return -ENOTCONN;
+        }
+        if (fds[0].revents & ZSOCK_POLLIN) {
+            rc = mqtt_input(client);
+            if (rc != 0) {
+                LOG_ERR("Input failed: %d", rc);
+                return rc;
+            }
+        }
+    }
+
+    rc = mqtt_live(client);
+    if (rc != 0 && rc != -EAGAIN) {
+        LOG_ERR("Ping failed: %d", rc);
         return rc;
     }
 
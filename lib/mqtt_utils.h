@@ -9,10 +9,18 @@
 #define MQTT_BROKER_ADDR  "fd17:6335:af0:2:0:0:c0a8:105"
 #define MQTT_BROKER_PORT 1883
 
+#define MQTT_UTILS_TOPIC_MAX_LEN   64
+#define MQTT_UTILS_PAYLOAD_MAX_LEN 64
+
+/* Called from mqtt_input() context for every incoming PUBLISH */
+typedef void (*mqtt_utils_msg_handler_t)(const char *topic, const char *payload, size_t len);
+
 void mqtt_utils_set_credentials(const char *client_id, const char *username, const char *password);
+void mqtt_utils_set_msg_handler(mqtt_utils_msg_handler_t handler);
 int mqtt_utils_connect(struct mqtt_client *client);
+int mqtt_utils_subscribe(struct mqtt_client *client, const char *topic);
 int mqtt_utils_publish(struct mqtt_client *client, const char *topic, const char *payload);
-int mqtt_utils_keepalive(struct mqtt_client *client);
+int mqtt_utils_process(struct mqtt_client *client, int32_t timeout_ms);
 void mqtt_utils_disconnect(struct mqtt_client *client);
 
 #endif /* MQTT_UTILS_H */
\ No newline at end of file
@@ -0,0 +1,181 @@
+#include "pm_utils.h"
+#include <zephyr/device.h>
+#include <zephyr/pm/device.h>
+#include <zephyr/pm/device_runtime.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/logging/log_ctrl.h>
+
+LOG_MODULE_REGISTER(pm_utils, LOG_LEVEL_INF);
+
+#define LOG_THREAD_STACK_SIZE 1536
+#define LOG_THREAD_IDLE_MS    1000
+
+static const struct device *const console = DEVICE_DT_GET(DT_CHOSEN(zephyr_console));
+
+static pm_utils_hook_t suspend_hook;
+static pm_utils_hook_t resume_hook;
+static bool console_pm;       // Runtime PM enabled on the console device
+static bool console_pinned;   // Console kept awake on request
+static bool console_released; // Our runtime PM reference has been put
+static bool suspended;
+static uint32_t suspend_us;
+static uint32_t resume_us_max;
+
+static K_MUTEX_DEFINE(log_lock);
+static K_SEM_DEFINE(log_wake, 0, 1);
+
+/*
+ * Replaces the Zephyr log thread (CONFIG_LOG_PROCESS_THREAD=n). While the
+ * console is released, deferred messages stay queued in the log buffer and
+ * are written after resume; only the oldest are lost if the buffer fills up.
+ * All log backends of this application sit on the console.
+ */
+static void log_thread(void *p1, void *p2, void *p3)
+{
+    ARG_UNUSED(p1);
+    ARG_UNUSED(p2);
+    ARG_UNUSED(p3);
+
+    while (1) {
+        k_mutex_lock(&log_lock, K_FOREVER);
+        if (console_released) {
+            k_mutex_unlock(&log_lock);
+            k_sem_take(&log_wake, K_FOREVER);
+            continue;
+        }
+        bool pending = log_process();
+        k_mutex_unlock(&log_lock);
+
+        if (!pending) {
+            k_sem_take(&log_wake, K_MSEC(LOG_THREAD_IDLE_MS));
+        }
+    }
+}
+
+K_THREAD_DEFINE(pm_log_thread, LOG_THREAD_STACK_SIZE, log_thread, NULL, NULL, NULL,
+                K_LOWEST_APPLICATION_THREAD_PRIO, 0, 0);
+
+int pm_utils_init(pm_utils_hook_t bus_suspend, pm_utils_hook_t bus_resume)
+{
+    suspend_hook = bus_suspend;
+    resume_hook = bus_resume;
+
+    if (!device_is_ready(console)) {
+        LOG_WRN("Console not ready");
+        return -ENODEV;
+    }
+
+    // Fails with -ENOTSUP for consoles without a PM action, such as the USB
+    // CDC ACM console on xiao_ble. Only the bus hooks run in that case.
+    int rc = pm_device_runtime_enable(console);
+    if (rc != 0) {
+        LOG_WRN("No runtime PM on console %s (%d), only sensor bus pins are idled",
+                console->name, rc);
+        return rc;
+    }
+
+    // Hold a reference while awake, released again in pm_utils_suspend()
+    rc = pm_device_runtime_get(console);
+    if (rc != 0) {
+        LOG_ERR("Console resume failed: %d", rc);
+        // Usage count is 0 here, leaving runtime PM on would keep it suspended
+        pm_device_runtime_disable(console);
+        return rc;
+    }
+
+    console_pm = true;
+    LOG_INF("Runtime PM enabled for %s", console->name);
+    return 0;
+}
+
+static void console_release(void)
+{
+    if (!console_pm || console_pinned || console_released) {
+        return;
+    }
+
+    // Drain what is queued, later messages wait for console_acquire()
+    k_mutex_lock(&log_lock, K_FOREVER);
+    while (log_process()) {
+    }
+    int rc = pm_device_runtime_put(console);
+    if (rc == 0) {
+        console_released = true;
+    }
+    k_mutex_unlock(&log_lock);
+
+    if (rc != 0) {
+        LOG_ERR("Console suspend failed: %d", rc);
+    }
+}
+
+static void console_acquire(void)
+{
+    if (!console_released) {
+        return;
+    }
+
+    int rc = pm_device_runtime_get(console);
+    if (rc != 0) {
+        // Messages stay queued, nothing could be written anyway
+        return;
+    }
+
+    k_mutex_lock(&log_lock, K_FOREVER);
+    console_released = false;
+    k_mutex_unlock(&log_lock);
+    k_sem_give(&log_wake);
+}
+
+void pm_utils_suspend(void)
+{
+    if (suspended) {
+        return;
+    }
+
+    uint32_t start = k_cycle_get_32();
+    if (suspend_hook) {
+        suspend_hook();
+    }
+    suspend_us = k_cyc_to_us_ceil32(k_cycle_get_32() - start);
+    suspended = true;
+
+    // Last, so draining the log queue does not count as suspend latency
+    console_release();
+}
+
+void pm_utils_resume(void)
+{
+    if (!suspended) {
+        return;
+    }
+
+    uint32_t start = k_cycle_get_32();
+    console_acquire();
+    if (resume_hook) {
+        resume_hook();
+    }
+    uint32_t resume_us = k_cyc_to_us_ceil32(k_cycle_get_32() - start);
+    suspended = false;
+
+    if (resume_us > resume_us_max) {
+        resume_us_max = resume_us;
+    }
+
+    if (resume_us > PM_UTILS_WAKE_MARGIN_MS * 1000U) {
+        LOG_WRN("Resume took %u us, exceeds %d ms wake margin", resume_us, PM_UTILS_WAKE_MARGIN_MS);
+    } else {
+        LOG_INF("Suspend %u us, resume %u us (max %u us)", suspend_us, resume_us, resume_us_max);
+    }
+}
+
+void pm_utils_console_request(bool on)
+{
+    LOG_INF("Console %s", on ? "pinned awake" : "released");
+    console_pinned = on;
+    if (on) {
+        console_acquire();
+    } else if (suspended) {
+        console_release();
+    }
+}
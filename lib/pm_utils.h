@@ -0,0 +1,27 @@
+#ifndef PM_UTILS_H
+#define PM_UTILS_H
+
+#include <zephyr/kernel.h>
+#include <stdbool.h>
+
+/*
+ * Idles the sensor buses between cycles (bus hooks) and, where the console
+ * device supports runtime PM, releases the console too. On xiao_ble the
+ * console is USB CDC ACM, which has no PM action: only the bus hooks run
+ * there, and the console suspend path is untested on that board.
+ *
+ * Also owns log processing: deferred messages are held while the console
+ * is released (needs CONFIG_LOG_PROCESS_THREAD=n).
+ */
+
+// Resume this long before a scheduled acquisition
+#define PM_UTILS_WAKE_MARGIN_MS 50
+
+typedef void (*pm_utils_hook_t)(void);
+
+int pm_utils_init(pm_utils_hook_t bus_suspend, pm_utils_hook_t bus_resume);
+void pm_utils_suspend(void);
+void pm_utils_resume(void);
+void pm_utils_console_request(bool on);
+
+#endif /* PM_UTILS_H */
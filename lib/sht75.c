@@ -16,7 +16,13 @@ LOG_MODULE_REGISTER(sht75, LOG_LEVEL_INF);
 #define PULSE_LONG  k_busy_wait(5)
 #define PULSE_SHORT k_busy_wait(2)
 #define WRITE_SR    0x06
-#define STATUS_14BIT 0x00
+#define READ_SR     0x07
+
+// Worst-case measurement times with 2x margin
+#define TIMEOUT_HIGH_RES_MS 720 // 14-bit T: 320 ms, 12-bit RH: 80 ms
+#define TIMEOUT_LOW_RES_MS  200 // 12-bit T: 80 ms, 8-bit RH: 20 ms
+
+static uint8_t status_reg;
 
 static void start_transmission(const struct sht75_config *cfg)
 {
@@ -36,6 +42,20 @@ static void start_transmission(const struct sht75_config *cfg)
     SCK_LOW(cfg);
 }
 
+// Datasheet connection reset: 9+ SCK cycles with DATA high
+static void connection_reset(const struct sht75_config *cfg)
+{
+    DATA_OUT(cfg);
+    DATA_HIGH(cfg);
+    for (int i = 0; i < 9; i++) {
+        SCK_HIGH(cfg);
+        PULSE_LONG;
+        SCK_LOW(cfg);
+        PULSE_LONG;
+    }
+    DATA_IN(cfg);
+}
+
 static int send_byte(const struct sht75_config *cfg, uint8_t byte)
 {
     DATA_OUT(cfg);
@@ -109,7 +129,8 @@ static uint16_t read_word(const struct sht75_config *cfg, uint8_t cmd)
     uint8_t crc = read_byte(cfg, false);
     uint16_t value = (msb << 8) | lsb;
 
-    uint8_t crc_calc = 0;
+    // CRC starts from the reversed low nibble of the status register
+    uint8_t crc_calc = bitrev(status_reg & 0x0F);
     crc_calc = calc_crc(cmd, crc_calc);
     crc_calc = calc_crc(msb, crc_calc);
     crc_calc = calc_crc(lsb, crc_calc);
@@ -118,6 +139,58 @@ static uint16_t read_word(const struct sht75_config *cfg, uint8_t cmd)
     return value;
 }
 
+static int read_status(const struct sht75_config *cfg, uint8_t *status)
+{
+    start_transmission(cfg);
+    if (send_byte(cfg, READ_SR) != 0) return -EIO;
+    uint8_t value = read_byte(cfg, true);
+    uint8_t crc = read_byte(cfg, false);
+
+    uint8_t crc_calc = bitrev(status_reg & 0x0F);
+    crc_calc = calc_crc(READ_SR, crc_calc);
+    crc_calc = calc_crc(value, crc_calc);
+    crc_calc = bitrev(crc_calc);
+    if (crc != crc_calc) return -EBADMSG;
+
+    *status = value;
+    return 0;
+}
+
+int sht75_set_status(const struct sht75_config *cfg, uint8_t status)
+{
+    uint8_t readback;
+    uint8_t prev = status_reg;
+
+    status &= SHT75_STATUS_MASK;
+    start_transmission(cfg);
+    if (send_byte(cfg, WRITE_SR) != 0 || send_byte(cfg, status) != 0) return -EIO;
+
+    // The read-back CRC is seeded from the new value, keep it only once verified
+    status_reg = status;
+    int ret = read_status(cfg, &readback);
+    if (ret != 0) {
+        LOG_ERR("Status read-back failed: %d", ret);
+        status_reg = prev;
+        return ret;
+    }
+    if ((readback & SHT75_STATUS_MASK) != status) {
+        LOG_ERR("Status mismatch: wrote 0x%02X, read 0x%02X", status, readback);
+        status_reg = prev;
+        return -EIO;
+    }
+
+    LOG_INF("Status 0x%02X (%s resolution%s%s)", status,
+            (status & SHT75_STATUS_LOW_RES) ? "low" : "high",
+            (status & SHT75_STATUS_NO_RELOAD) ? ", no OTP reload" : "",
+            (status & SHT75_STATUS_HEATER) ? ", heater on" : "");
+    return 0;
+}
+
+int sht75_get_status(const struct sht75_config *cfg, uint8_t *status)
+{
+    return read_status(cfg, status);
+}
+
 int sht75_init(const struct sht75_config *cfg)
 {
     if (!device_is_ready(cfg->gpio_dev)) return -ENODEV;
@@ -128,43 +201,71 @@ int sht75_init(const struct sht75_config *cfg)
 
     SCK_LOW(cfg);
     DATA_HIGH(cfg);
-    start_transmission(cfg);
-    if (send_byte(cfg, WRITE_SR) != 0 || send_byte(cfg, STATUS_14BIT) != 0) return -1;
+    status_reg = 0; // Power-on default
+    ret = sht75_set_status(cfg, cfg->status);
 
     DATA_OUT(cfg);
     DATA_LOW(cfg);
     k_busy_wait(100);
     DATA_IN(cfg);
-    return 0;
+    return ret;
 }
 
-int sht75_read(const struct sht75_config *cfg, struct sht75_data *data)
+static int measure(const struct sht75_config *cfg, uint8_t cmd, int timeout_ms, uint16_t *raw)
 {
     start_transmission(cfg);
-    if (send_byte(cfg, SHT75_CMD_TEMP) != 0) return -EIO;
-    int timeout = 240;
+    if (send_byte(cfg, cmd) != 0) return -EIO;
+    int timeout = timeout_ms / 3;
     while (DATA_READ(cfg) && timeout > 0) {
         k_msleep(3);
         timeout--;
     }
     if (timeout == 0) return -ETIMEDOUT;
-    uint16_t temp_raw = read_word(cfg, SHT75_CMD_TEMP);
-    if (temp_raw == 0xFFFF) return -EIO;
-    data->temperature = -40.1f + 0.01f * temp_raw;
+    *raw = read_word(cfg, cmd);
+    if (*raw == 0xFFFF) return -EBADMSG;
+    return 0;
+}
 
-    start_transmission(cfg);
-    if (send_byte(cfg, SHT75_CMD_HUMID) != 0) return -EIO;
-    timeout = 240;
-    while (DATA_READ(cfg) && timeout > 0) {
-        k_msleep(3);
-        timeout--;
+int sht75_read(const struct sht75_config *cfg, struct sht75_data *data)
+{
+    bool low_res = status_reg & SHT75_STATUS_LOW_RES;
+    int timeout_ms = low_res ? TIMEOUT_LOW_RES_MS : TIMEOUT_HIGH_RES_MS;
+    uint16_t temp_raw, humid_raw;
+    int ret;
+
+    // Resync the serial interface after a failure so the next cycle starts clean
+    ret = measure(cfg, SHT75_CMD_TEMP, timeout_ms, &temp_raw);
+    if (ret != 0) {
+        connection_reset(cfg);
+        return ret;
     }
-    if (timeout == 0) return -ETIMEDOUT;
-    uint16_t humid_raw = read_word(cfg, SHT75_CMD_HUMID);
-    if (humid_raw == 0xFFFF) return -EIO;
-    float rh_linear = -2.0468f + 0.0367f * humid_raw + (-1.5955e-6f * humid_raw * humid_raw);
-    float rh_true = (data->temperature - 25.0f) * (0.01f + 0.00008f * humid_raw) + rh_linear;
+    data->temperature = -40.1f + (low_res ? 0.04f : 0.01f) * temp_raw;
+
+    ret = measure(cfg, SHT75_CMD_HUMID, timeout_ms, &humid_raw);
+    if (ret != 0) {
+        connection_reset(cfg);
+        return ret;
+    }
+
+    // Coefficients from the SHT7x datasheet, 12-bit vs 8-bit humidity
+    const float c2 = low_res ? 0.5872f : 0.0367f;
+    const float c3 = low_res ? -4.0845e-4f : -1.5955e-6f;
+    const float t2 = low_res ? 0.00128f : 0.00008f;
+    float rh_linear = -2.0468f + c2 * humid_raw + (c3 * humid_raw * humid_raw);
+    float rh_true = (data->temperature - 25.0f) * (0.01f + t2 * humid_raw) + rh_linear;
     data->humidity = (rh_true > 100.0f) ? 100.0f : (rh_true < 0.1f) ? 0.1f : rh_true;
 
     return 0;
+}
+
+// SCK stays driven low so the sensor sees no spurious clocks, DATA floats on its pull-up
+int sht75_suspend(const struct sht75_config *cfg)
+{
+    SCK_LOW(cfg);
+    return gpio_pin_configure_dt(&(struct gpio_dt_spec){.port = cfg->gpio_dev, .pin = cfg->data_pin}, GPIO_DISCONNECTED);
+}
+
+int sht75_resume(const struct sht75_config *cfg)
+{
+    return DATA_IN(cfg);
 }
\ No newline at end of file
@@ -7,10 +7,17 @@
 #define SHT75_CMD_TEMP  0x03 // Measure temperature
 #define SHT75_CMD_HUMID 0x05 // Measure humidity
 
+// Status register bits
+#define SHT75_STATUS_LOW_RES   0x01 // 12-bit temperature / 8-bit humidity
+#define SHT75_STATUS_NO_RELOAD 0x02 // Skip OTP calibration reload before each measurement
+#define SHT75_STATUS_HEATER    0x04 // On-chip heater
+#define SHT75_STATUS_MASK      0x07 // Writable bits
+
 struct sht75_config {
     const struct device *gpio_dev;
     uint8_t sck_pin;  // Clock pin
     uint8_t data_pin; // Data pin
+    uint8_t status;   // Initial status register (SHT75_STATUS_*), 0 = 14/12-bit
 };
 
 struct sht75_data {
@@ -20,5 +27,9 @@ struct sht75_data {
 
 int sht75_init(const struct sht75_config *cfg);
 int sht75_read(const struct sht75_config *cfg, struct sht75_data *data);
+int sht75_set_status(const struct sht75_config *cfg, uint8_t status);
+int sht75_get_status(const struct sht75_config *cfg, uint8_t *status);
+int sht75_suspend(const struct sht75_config *cfg);
+int sht75_resume(const struct sht75_config *cfg);
 
 #endif /* SHT75_H */
\ No newline at end of file
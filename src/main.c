@@ -14,9 +14,14 @@
 #include <zephyr/logging/log.h>
 #include <zephyr/kernel.h>
 #include <stdio.h>
+#include <string.h>
+#include <math.h>
 #include "thread_utils.h"
 #include "mqtt_utils.h"
 #include "shell_utils.h"
+#include "cmd_utils.h"
+#include "pm_utils.h"
+#include "health_utils.h"
 #include "sht75.h"
 #include "ds18b20.h"
 
@@ -30,14 +35,18 @@ LOG_MODULE_REGISTER(main, LOG_LEVEL_INF);
 #define MQTT_PASSWORD  "ot_node_template_2"
 #define MQTT_TOPIC_TEMP   NODE_ID "-out/temp"
 #define MQTT_TOPIC_HUMID  NODE_ID "-out/humidity"
+#define MQTT_TOPIC_HEALTH NODE_ID "-out/health"
+#define MQTT_TOPIC_CMD    NODE_ID "-in/cmd"
 #define POLL_INTERVAL_MS  300000 // 5 minuten (300s)
 
 #if USE_SHT75_SENSOR
 static const struct sht75_config sht75_cfg = {
     .gpio_dev = DEVICE_DT_GET(DT_NODELABEL(gpio1)),
     .sck_pin = 13,
-    .data_pin = 14
+    .data_pin = 14,
+    .status = 0 // SHT75_STATUS_LOW_RES voor ~4x snellere metingen
 };
+static struct health_state sht75_health;
 #endif
 
 #if USE_DS18B20_SENSOR
@@ -46,17 +55,224 @@ static const struct ds18b20_config ds_cfg = {
     .gpio_dev = DEVICE_DT_GET(DT_NODELABEL(gpio1)),
     .data_pin = DS18B20_DATA_PIN
 };
+// Geen alarm zolang floor(T) binnen floor(laatste meting) +/- MARGIN blijft
+// (TH/TL vergelijken alleen het gehele deel van de meting)
+#define DS18B20_ALARM_MARGIN_C   1
+#define DS18B20_FULL_SWEEP_EVERY 12  // volledige uitlezing elke 12 cycli (1 uur)
 static struct ds18b20_rom sensors[DS18B20_MAX_SENSORS];
 static int sensor_count = 0;
+static int sweep_countdown = 0;
+static struct health_state ds_health[DS18B20_MAX_SENSORS];
 #endif
 
 static struct mqtt_client client;
 
+/* Rapportagekanalen voor cmd_utils_should_report() */
+#define CHANNEL_SHT75_TEMP   0
+#define CHANNEL_SHT75_HUMID  1
+#define CHANNEL_DS18B20(i)   (2 + (i))
+
+#if USE_SHT75_SENSOR || USE_DS18B20_SENSOR
+static void publish_health(const char *topic, const struct health_state *h)
+{
+    char payload[32];
+    health_utils_format(h, payload, sizeof(payload));
+    mqtt_utils_publish(&client, topic, payload);
+}
+#endif
+
+#if USE_DS18B20_SENSOR
+static int find_sensor(const struct ds18b20_rom *rom)
+{
+    for (int i = 0; i < sensor_count; i++) {
+        if (memcmp(sensors[i].rom, rom->rom, sizeof(rom->rom)) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+static bool ds_any_available(void)
+{
+    for (int i = 0; i < sensor_count; i++) {
+        if (health_utils_available(&ds_health[i])) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void ds_report_health(int i, int rc, bool force)
+{
+    if (health_utils_report(&ds_health[i], rc) || force) {
+        char topic[64];
+        snprintf(topic, sizeof(topic), "%s/ds18b20_%d/health", NODE_ID, i);
+        publish_health(topic, &ds_health[i]);
+    }
+}
+
+static void ds_read_and_publish(int i, bool force)
+{
+    float temp;
+    int rc;
+
+    if (!health_utils_available(&ds_health[i])) {
+        return;
+    }
+
+    // Alleen CRC fouten opnieuw proberen, een ontbrekende sensor kost geen extra tijd
+    for (int attempt = 0; ; attempt++) {
+        rc = ds18b20_read_result(&ds_cfg, &sensors[i], &temp);
+        if (rc != -EBADMSG || attempt >= HEALTH_UTILS_MAX_RETRIES) {
+            break;
+        }
+    }
+
+    ds_report_health(i, rc, force);
+
+    if (rc != 0) {
+        LOG_ERR("DS18B20 read failed for sensor %d: %d", i, rc);
+        return;
+    }
+
+    // Alarm bij floor(T) <= TL of >= TH, dus TL/TH een graad buiten het venster leggen
+    int8_t t = (int8_t)floorf(temp);
+    if (ds18b20_set_alarm(&ds_cfg, &sensors[i], t - DS18B20_ALARM_MARGIN_C - 1,
+                          t + DS18B20_ALARM_MARGIN_C + 1) != 0) {
+        LOG_WRN("DS18B20 alarm setup failed for sensor %d", i);
+    }
+
+    if (!cmd_utils_should_report(CHANNEL_DS18B20(i), temp, force)) {
+        return;
+    }
+
+    char topic[64];
+    char payload[16];
+    snprintf(payload, sizeof(payload), "%.2f", (double)temp);
+    snprintf(topic, sizeof(topic),"%s/ds18b20_%d/temp", NODE_ID, i);
+
+    mqtt_utils_publish(&client, topic, payload);
+}
+#endif
+
+static void bus_suspend(void)
+{
+#if USE_SHT75_SENSOR
+    sht75_suspend(&sht75_cfg);
+#endif
+#if USE_DS18B20_SENSOR
+    ds18b20_suspend(&ds_cfg);
+#endif
+}
+
+static void bus_resume(void)
+{
+#if USE_SHT75_SENSOR
+    sht75_resume(&sht75_cfg);
+#endif
+#if USE_DS18B20_SENSOR
+    ds18b20_resume(&ds_cfg);
+#endif
+}
+
+static void acquire_and_publish(bool force)
+{
+#if USE_SHT75_SENSOR
+    bool low_res;
+    if (cmd_utils_take_resolution_change(&low_res)) {
+        uint8_t status;
+        if (sht75_get_status(&sht75_cfg, &status) != 0) {
+            status = sht75_cfg.status;
+        }
+        status = low_res ? (status | SHT75_STATUS_LOW_RES) : (status & ~SHT75_STATUS_LOW_RES);
+        if (sht75_set_status(&sht75_cfg, status) != 0) {
+            LOG_WRN("SHT-75 resolution change failed");
+        } else {
+            LOG_INF("SHT-75 resolution: %s", low_res ? "low" : "high");
+        }
+    }
+
+    struct sht75_data sht75_data;
+    int rc = -EBUSY;
+    if (health_utils_available(&sht75_health)) {
+        for (int attempt = 0; ; attempt++) {
+            rc = sht75_read(&sht75_cfg, &sht75_data);
+            if (rc != -EBADMSG || attempt >= HEALTH_UTILS_MAX_RETRIES) {
+                break;
+            }
+        }
+        if (health_utils_report(&sht75_health, rc) || force) {
+            publish_health(MQTT_TOPIC_HEALTH, &sht75_health);
+        }
+    }
+
+    if (rc == 0) {
+        char temp_str[16], humid_str[16];
+        if (cmd_utils_should_report(CHANNEL_SHT75_TEMP, sht75_data.temperature, force)) {
+            snprintf(temp_str, sizeof(temp_str), "%.2f", (double)sht75_data.temperature);
+            mqtt_utils_publish(&client, MQTT_TOPIC_TEMP, temp_str);
+        }
+        if (cmd_utils_should_report(CHANNEL_SHT75_HUMID, sht75_data.humidity, force)) {
+            snprintf(humid_str, sizeof(humid_str), "%.2f", (double)sht75_data.humidity);
+            mqtt_utils_publish(&client, MQTT_TOPIC_HUMID, humid_str);
+        }
+    } else if (rc != -EBUSY) {
+        LOG_ERR("SHT-75 read failed: %d", rc);
+    }
+#endif
+
+#if USE_DS18B20_SENSOR
+    int ds_rc;
+
+    if (!ds_any_available()) {
+        // Geen sensoren of alles in quarantaine: geen conversie en geen 750 ms wachten
+        LOG_DBG("No DS18B20 sensor available, skipping conversion");
+    } else if ((ds_rc = ds18b20_convert_all(&ds_cfg)) != 0) {
+        LOG_ERR("DS18B20 conversion failed: %d", ds_rc);
+        // Geen presence pulse: telt als fout voor elke sensor die niet in quarantaine zit
+        for (int i = 0; i < sensor_count; i++) {
+            if (health_utils_available(&ds_health[i])) {
+                ds_report_health(i, ds_rc, force);
+            }
+        }
+    } else if (force || sweep_countdown <= 0) {
+        sweep_countdown = DS18B20_FULL_SWEEP_EVERY;
+        for (int i = 0; i < sensor_count; i++) {
+            ds_read_and_publish(i, force);
+        }
+    } else {
+        struct ds18b20_rom alarmed[DS18B20_MAX_SENSORS];
+        bool done[DS18B20_MAX_SENSORS] = {0};
+        int n = ds18b20_alarm_search(&ds_cfg, alarmed, DS18B20_MAX_SENSORS);
+
+        sweep_countdown--;
+        LOG_INF("%d of %d DS18B20 sensor(s) outside alarm window", n, sensor_count);
+        for (int j = 0; j < n; j++) {
+            int i = find_sensor(&alarmed[j]);
+            if (i >= 0) {
+                ds_read_and_publish(i, force);
+                done[i] = true;
+            }
+        }
+
+        // Een falende sensor komt nooit uit de alarm search, dus direct uitlezen
+        for (int i = 0; i < sensor_count; i++) {
+            if (!done[i] && ds_health[i].status != HEALTH_OK) {
+                ds_read_and_publish(i, force);
+            }
+        }
+    }
+#endif
+
+    ARG_UNUSED(force);
+}
+
 int main(void)
 {
     LOG_INF("Starting Sensor Node...");
 
 #if USE_SHT75_SENSOR
+    health_utils_init(&sht75_health, "sht75");
     if (sht75_init(&sht75_cfg) != 0) {
         LOG_WRN("SHT-75 init failed — continuing without it");
     }
@@ -69,6 +285,11 @@ int main(void)
         return -1;
     }
     sensor_count = ds18b20_scan(&ds_cfg, sensors, DS18B20_MAX_SENSORS);
+    for (int i = 0; i < sensor_count; i++) {
+        char label[16];
+        snprintf(label, sizeof(label), "ds18b20_%d", i);
+        health_utils_init(&ds_health[i], label);
+    }
     LOG_INF("Found %d DS18B20 sensor(s)", sensor_count);
     if (sensor_count == 0) {
         LOG_WRN("No DS18B20 sensors found");
@@ -81,7 +302,15 @@ int main(void)
     }
 
     shell_utils_init();
+    cmd_utils_init(POLL_INTERVAL_MS);
+#if USE_SHT75_SENSOR
+    cmd_utils_enable_resolution(true);
+#endif
+    if (pm_utils_init(bus_suspend, bus_resume) != 0) {
+        LOG_WRN("Console stays powered, only sensor bus pins are idled");
+    }
     mqtt_utils_set_credentials(NODE_ID, MQTT_USERNAME, MQTT_PASSWORD);
+    mqtt_utils_set_msg_handler(cmd_utils_handle);
 
     LOG_INF("Waiting 10s for network...");
     k_sleep(K_SECONDS(10));
@@ -93,46 +322,51 @@ int main(void)
             continue;
         }
 
+        if (mqtt_utils_subscribe(&client, MQTT_TOPIC_CMD) != 0) {
+            LOG_WRN("Command channel unavailable");
+        }
+
+        int64_t last_cycle = k_uptime_get();
+        bool first = true;
+
         while (1) {
-#if USE_SHT75_SENSOR
-            struct sht75_data sht75_data;
-            if (sht75_read(&sht75_cfg, &sht75_data) == 0) {
-                char temp_str[16], humid_str[16];
-                snprintf(temp_str, sizeof(temp_str), "%.2f", (double)sht75_data.temperature);
-                snprintf(humid_str, sizeof(humid_str), "%.2f", (double)sht75_data.humidity);
-                mqtt_utils_publish(&client, MQTT_TOPIC_TEMP, temp_str);
-                mqtt_utils_publish(&client, MQTT_TOPIC_HUMID, humid_str);
-            } else {
-                LOG_ERR("SHT-75 read failed");
-                break;
+            // Een "read" commando mag het vaste schema niet verschuiven
+            bool forced = cmd_utils_take_read_request();
+            int64_t next_cycle = last_cycle + cmd_utils_get_interval_ms();
+            bool console_on;
+
+            if (cmd_utils_take_console_request(&console_on)) {
+                pm_utils_console_request(console_on);
             }
-#endif
 
-#if USE_DS18B20_SENSOR
-            for (int i = 0; i < sensor_count; i++) {
-                float temp;
-                if (ds18b20_read_temp(&ds_cfg, &sensors[i], &temp) == 0) {
-                    char topic[64];
-                    char payload[16];
-                    snprintf(payload, sizeof(payload), "%.2f", (double)temp);
-                    snprintf(topic, sizeof(topic),"%s/ds18b20_%d/temp", NODE_ID, i);
-
-                    mqtt_utils_publish(&client, topic, payload);
-                } else {
-                    LOG_ERR("DS18B20 read failed for sensor %d", i);
+            if (first || forced || k_uptime_get() >= next_cycle) {
+                pm_utils_resume();
+                if (!forced) {
+                    last_cycle = k_uptime_get();
+                    first = false;
                 }
+                acquire_and_publish(forced);
+                continue;
             }
-#endif
 
-            k_sleep(K_MSEC(POLL_INTERVAL_MS - 5000)); // 295s slaap
-            if (mqtt_utils_keepalive(&client) != 0) {
-                LOG_ERR("Keepalive failed");
+            // Slapen tot vlak voor de volgende meting, dan op tijd wakker worden
+            int64_t now = k_uptime_get();
+            int64_t wake_at = next_cycle - PM_UTILS_WAKE_MARGIN_MS;
+            int64_t wait_ms;
+            if (now < wake_at) {
+                pm_utils_suspend();
+                wait_ms = wake_at - now;
+            } else {
+                pm_utils_resume();
+                wait_ms = next_cycle - now;
+            }
+            if (mqtt_utils_process(&client, (int32_t)MAX(wait_ms, 0)) != 0) {
+                LOG_ERR("MQTT connection lost");
                 break;
             }
-
-            k_sleep(K_MSEC(5000)); // 5s na keepalive
         }
 
+        pm_utils_resume();
         mqtt_utils_disconnect(&client);
         k_sleep(K_SECONDS(5));
     }